@@ -0,0 +1,366 @@
+////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Opt-in allocation tracker shared by Hose and Pong.
+//
+//	Build with TRACK_ALLOCATIONS defined to turn it on. Without it, ALLOC_SITE does nothing and
+//	allocFrameEnd just returns true, so it costs nothing in a normal build.
+//
+//	When on, every heap allocation and free is counted:
+//		glibc:		malloc/calloc/realloc/free and the aligned versions are hooked, which covers new/delete too.
+//		Elsewhere:	global new/delete are replaced. (No portable way to hook malloc, so raylib's own mallocs don't show up.)
+//
+//	ALLOC_SITE("name") marks everything allocated from there to the end of the enclosing block (or the next ALLOC_SITE) as coming from "name".
+//	Sites nest: when the block ends, whatever site was in effect before it takes over again, so a function marking its own
+//	allocations doesn't steal the ones its caller makes after it returns.
+//	allocFrameEnd() gets called once per frame. Every ALLOC_REPORT_FRAMES frames it prints allocations, frees and bytes per frame,
+//	what's live, the peak heap and peak resident size, and a line for each site that allocated.
+//
+//	Budget test mode: also define ALLOC_BUDGET=<bytes>. Once the first ALLOC_WARMUP_FRAMES frames are over, any frame that allocates
+//	more than that prints what allocated and makes allocFrameEnd return false, so the program can exit with an error.
+//	ALLOC_BUDGET=0 holds the steady-state frame to zero allocations.
+//
+////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#ifndef TRACK_ALLOCATIONS
+
+#define ALLOC_SITE(name) ((void)0)
+inline bool allocFrameEnd() { return true; }
+
+#else
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#ifndef ALLOC_REPORT_FRAMES
+#define ALLOC_REPORT_FRAMES 60		// Frames between reports.
+#endif
+#ifndef ALLOC_WARMUP_FRAMES
+#define ALLOC_WARMUP_FRAMES 120		// Frames ignored by the budget check while things get set up.
+#endif
+
+namespace allocTrack
+{
+	const int MAX_SITES = 16;
+
+	// Running count of allocations and bytes.
+	struct Counts
+	{
+		std::atomic<long long> allocs{}, frees{}, bytes{}, freedBytes{};
+
+		void add(const Counts& other)
+		{
+			allocs += other.allocs;
+			frees += other.frees;
+			bytes += other.bytes;
+			freedBytes += other.freedBytes;
+		}
+
+		void clear()
+		{
+			allocs = 0;
+			frees = 0;
+			bytes = 0;
+			freedBytes = 0;
+		}
+	};
+
+	// A named place in the code that allocations get attributed to.
+	struct Site
+	{
+		const char* name;
+		Counts frame, period;
+
+		Site(const char* name);
+	};
+
+	// Makes a site current for as long as it's in scope, then puts back whichever one was current before.
+	struct SiteScope
+	{
+		Site* previous;
+
+		SiteScope(Site& site);
+		~SiteScope();
+		SiteScope(const SiteScope&) = delete;
+		SiteScope& operator=(const SiteScope&) = delete;
+	};
+
+	inline Site* sites[MAX_SITES];
+	inline std::atomic<int> siteCount{};
+	inline thread_local Site* current{};
+
+	inline Counts frame, period;				// This frame so far, and this report period so far.
+	inline std::atomic<long long> live{}, peak{};	// Bytes currently allocated, and the most there's ever been.
+	inline long long frameNumber{}, periodStart{};
+	inline bool overBudget{};
+
+	inline Site::Site(const char* name) : name{ name }
+	{
+		int index = siteCount++;
+		if (index < MAX_SITES)
+			sites[index] = this;
+	}
+
+	inline SiteScope::SiteScope(Site& site) : previous{ current }
+	{
+		current = &site;
+	}
+
+	inline SiteScope::~SiteScope()
+	{
+		current = previous;
+	}
+
+	// Actual size of the block at p, so frees can be counted without remembering sizes.
+	inline size_t blockSize(void* p)
+	{
+#if defined(_MSC_VER)
+		return _msize(p);
+#elif defined(__APPLE__)
+		return malloc_size(p);
+#else
+		return malloc_usable_size(p);
+#endif
+	}
+
+	inline void onAlloc(void* p)
+	{
+		if (!p)
+			return;
+		long long size = (long long)blockSize(p);
+		frame.allocs.fetch_add(1, std::memory_order_relaxed);
+		frame.bytes.fetch_add(size, std::memory_order_relaxed);
+		if (current)
+		{
+			current->frame.allocs.fetch_add(1, std::memory_order_relaxed);
+			current->frame.bytes.fetch_add(size, std::memory_order_relaxed);
+		}
+		long long now = live.fetch_add(size, std::memory_order_relaxed) + size;
+		long long highest = peak.load(std::memory_order_relaxed);
+		while (now > highest && !peak.compare_exchange_weak(highest, now, std::memory_order_relaxed)) {}
+	}
+
+	// Counts a freed block by its size, for when the block itself can't be looked at anymore.
+	inline void onFreeSize(long long size)
+	{
+		frame.frees.fetch_add(1, std::memory_order_relaxed);
+		frame.freedBytes.fetch_add(size, std::memory_order_relaxed);
+		if (current)
+		{
+			current->frame.frees.fetch_add(1, std::memory_order_relaxed);
+			current->frame.freedBytes.fetch_add(size, std::memory_order_relaxed);
+		}
+		live.fetch_sub(size, std::memory_order_relaxed);
+	}
+
+	inline void onFree(void* p)
+	{
+		if (p)
+			onFreeSize((long long)blockSize(p));
+	}
+
+	// Peak resident set size of the process in KB, or -1 if unknown.
+	inline long long peakResidentKB()
+	{
+#ifdef _WIN32
+		return -1;
+#else
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+#endif
+	}
+
+	inline void printCounts(const char* label, const Counts& c, long long frames)
+	{
+		std::printf("ALLOC:   %-16s %8.1f allocs %8.1f frees %10.1f bytes allocated %10.1f bytes freed per frame\n", label,
+			(double)c.allocs / frames, (double)c.frees / frames, (double)c.bytes / frames, (double)c.freedBytes / frames);
+	}
+}
+
+// Marks allocations from here to the end of the enclosing block (or the next ALLOC_SITE) as coming from name.
+#define ALLOC_SITE_CONCAT2(a, b) a##b
+#define ALLOC_SITE_CONCAT(a, b) ALLOC_SITE_CONCAT2(a, b)
+#define ALLOC_SITE(name) \
+	static allocTrack::Site ALLOC_SITE_CONCAT(allocSite_, __LINE__)(name); \
+	allocTrack::SiteScope ALLOC_SITE_CONCAT(allocSiteScope_, __LINE__)(ALLOC_SITE_CONCAT(allocSite_, __LINE__))
+
+// Call once at the end of every frame. Returns false if budget test mode is on and this frame went over budget.
+inline bool allocFrameEnd()
+{
+	using namespace allocTrack;
+	frameNumber++;
+	int count = siteCount < MAX_SITES ? (int)siteCount : MAX_SITES;
+
+#ifdef ALLOC_BUDGET
+	if (frameNumber > ALLOC_WARMUP_FRAMES && frame.bytes > ALLOC_BUDGET)
+	{
+		std::printf("ALLOC: frame %lld went over budget: %lld allocs, %lld bytes (budget %lld bytes)\n",
+			frameNumber, (long long)frame.allocs, (long long)frame.bytes, (long long)ALLOC_BUDGET);
+		for (int i{}; i < count; i++)
+			if (sites[i]->frame.allocs > 0)
+				printCounts(sites[i]->name, sites[i]->frame, 1);
+		std::fflush(stdout);
+		overBudget = true;
+	}
+#endif
+
+	period.add(frame);
+	frame.clear();
+	for (int i{}; i < count; i++)
+	{
+		sites[i]->period.add(sites[i]->frame);
+		sites[i]->frame.clear();
+	}
+
+	long long frames = frameNumber - periodStart;
+	if (frames >= ALLOC_REPORT_FRAMES)
+	{
+		long long rss = peakResidentKB();
+		std::printf("ALLOC: frames %lld-%lld, %lld bytes live, %lld bytes peak heap", periodStart + 1, frameNumber, (long long)live, (long long)peak);
+		if (rss >= 0)
+			std::printf(", %lld KB peak resident", rss);
+		std::printf("\n");
+		printCounts("total", period, frames);
+		for (int i{}; i < count; i++)
+			if (sites[i]->period.allocs > 0 || sites[i]->period.frees > 0)
+				printCounts(sites[i]->name, sites[i]->period, frames);
+		std::fflush(stdout);
+
+		// Anything printing just allocated gets dropped so it doesn't show up in the next frame.
+		period.clear();
+		frame.clear();
+		for (int i{}; i < count; i++)
+		{
+			sites[i]->period.clear();
+			sites[i]->frame.clear();
+		}
+		periodStart = frameNumber;
+	}
+
+	return !overBudget;
+}
+
+//////////////////////////////
+// Hooks
+#if defined(__GLIBC__)
+
+// glibc lets a program define its own malloc family. These count and then hand off to glibc's real ones.
+// operator new calls malloc here, so it's covered without replacing it.
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* p, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void* p);
+
+	void* malloc(size_t size) noexcept
+	{
+		void* p = __libc_malloc(size);
+		allocTrack::onAlloc(p);
+		return p;
+	}
+
+	void* calloc(size_t count, size_t size) noexcept
+	{
+		void* p = __libc_calloc(count, size);
+		allocTrack::onAlloc(p);
+		return p;
+	}
+
+	void* realloc(void* p, size_t size) noexcept
+	{
+		// The old block's size has to be read first, since p isn't safe to look at once realloc moves or frees it.
+		long long oldSize = p ? (long long)allocTrack::blockSize(p) : 0;
+		void* q = __libc_realloc(p, size);
+		// A failed realloc leaves the old block alone, so nothing happened that needs counting.
+		if (!q && size)
+			return q;
+		if (p)
+			allocTrack::onFreeSize(oldSize);
+		allocTrack::onAlloc(q);
+		return q;
+	}
+
+	void* memalign(size_t alignment, size_t size) noexcept
+	{
+		void* p = __libc_memalign(alignment, size);
+		allocTrack::onAlloc(p);
+		return p;
+	}
+
+	void* aligned_alloc(size_t alignment, size_t size) noexcept
+	{
+		return memalign(alignment, size);
+	}
+
+	// Same error codes as the real one: alignment has to be a power of two and a multiple of sizeof(void*).
+	int posix_memalign(void** out, size_t alignment, size_t size) noexcept
+	{
+		if (alignment == 0 || alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+			return EINVAL;
+		void* p = memalign(alignment, size);
+		if (!p)
+			return ENOMEM;
+		*out = p;
+		return 0;
+	}
+
+	void free(void* p) noexcept
+	{
+		allocTrack::onFree(p);
+		__libc_free(p);
+	}
+}
+
+#else
+
+// Everywhere else, replace global new and delete.
+inline void* allocTrackNew(size_t size)
+{
+	void* p = std::malloc(size ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	allocTrack::onAlloc(p);
+	return p;
+}
+
+inline void allocTrackDelete(void* p)
+{
+	allocTrack::onFree(p);
+	std::free(p);
+}
+
+void* operator new(size_t size) { return allocTrackNew(size); }
+void* operator new[](size_t size) { return allocTrackNew(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { try { return allocTrackNew(size); } catch (...) { return nullptr; } }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { try { return allocTrackNew(size); } catch (...) { return nullptr; } }
+void operator delete(void* p) noexcept { allocTrackDelete(p); }
+void operator delete[](void* p) noexcept { allocTrackDelete(p); }
+void operator delete(void* p, size_t) noexcept { allocTrackDelete(p); }
+void operator delete[](void* p, size_t) noexcept { allocTrackDelete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { allocTrackDelete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { allocTrackDelete(p); }
+
+#endif
+
+#endif
@@ -14,8 +14,11 @@
 //	Added menu to select difficulty, as well as variable AI difficulty for single-player game.
 //	Best-of-5 system for winning, instead of just 1 round.
 //	Variable vertical speed on ball depending on where it impacted paddle.
+//	Static text is rendered once into textures instead of being measured and drawn from scratch every frame.
+//	Menus only redraw when there's input, so the game sits nearly idle while waiting on a selection.
 //
 #include "raylib.h"
+#include "../AllocTracker.h"
 #include <cmath>
 
 
@@ -78,6 +81,70 @@ struct Paddle
 	}
 };
 
+// Text that never changes gets measured and rasterized once into its own texture, then is just copied to the screen each frame.
+// Has to be rendered after InitWindow, since it needs a graphics context.
+struct CachedText
+{
+	RenderTexture2D target{};
+	int width{}, height{};
+
+	// Measures text and draws it into a fresh texture, replacing whatever was cached before.
+	void render(const char* text, int fontSize, Color color)
+	{
+		unload();
+		width = MeasureText(text, fontSize);
+		height = fontSize;
+		target = LoadRenderTexture(width, height);
+		BeginTextureMode(target);
+			ClearBackground(BLANK);
+			DrawText(text, 0, 0, fontSize, color);
+		EndTextureMode();
+	}
+
+	// Render textures are stored upside-down, so the source rectangle is flipped with a negative height.
+	void draw(int x, int y) const
+	{
+		DrawTextureRec(target.texture, Rectangle{ 0, 0, (float)width, -(float)height }, Vector2{ (float)x, (float)y }, WHITE);
+	}
+
+	// Draws text centered horizontally on the screen.
+	void drawCentered(int y) const
+	{
+		draw((GetScreenWidth() - width) / 2, y);
+	}
+
+	void unload()
+	{
+		if (target.id != 0)
+			UnloadRenderTexture(target);
+		target = RenderTexture2D{};
+	}
+};
+
+// Score display that only re-renders its texture when the score it's showing actually changes.
+struct CachedScore
+{
+	CachedText text;
+	int shown{ -1 };
+	Color color;
+
+	CachedScore(Color color) : color{ color } {}
+
+	void update(int score)
+	{
+		if (score == shown)
+			return;
+		text.render(TextFormat("%d", score), 40, color);
+		shown = score;
+	}
+
+	void unload()
+	{
+		text.unload();
+		shown = -1;
+	}
+};
+
 
 int main()
 {	
@@ -88,6 +155,47 @@ int main()
 	Paddle leftPaddle(50);
 	Paddle rightPaddle(GetScreenWidth()-50-10);
 
+	// Render all the static text up front. Menu text is lined up with the left edge of the longest option.
+	CachedText title, onePlayer, twoPlayer, easy, normal, hard, pointP1, pointP2, winsP1, winsP2, pressSpace;
+	title.render("PONG", 100, WHITE);
+	onePlayer.render("1-Player Game", 50, BLUE);
+	twoPlayer.render("2-Player Game", 50, RED);
+	easy.render("Easy", 50, GREEN);
+	normal.render("Normal", 50, YELLOW);
+	hard.render("Hard", 50, RED);
+	pointP1.render("Point Player 1", 50, BLUE);
+	pointP2.render("Point Player 2", 50, RED);
+	winsP1.render("Player 1 Wins!", 60, BLUE);
+	winsP2.render("Player 2 Wins!", 60, RED);
+	pressSpace.render("(Press SPACE to Continue)", 30, WHITE);
+	const int playerMenuX = (GetScreenWidth() - onePlayer.width) / 2;
+	const int difficultyMenuX = (GetScreenWidth() - easy.width) / 2;
+
+	// Scores only get re-rendered when they change.
+	CachedScore leftScore(BLUE), rightScore(RED);
+	const int leftScoreX = MeasureText("0", 60) - 5;
+	const int rightScoreX = GetScreenWidth() - MeasureText("0", 60) - MeasureText("0", 40) + 5;
+
+	// Every cached texture has to be unloaded while the window (and its graphics context) is still open,
+	// so this is used in place of CloseWindow everywhere below.
+	auto closeWindow = [&]()
+	{
+		title.unload();
+		onePlayer.unload();
+		twoPlayer.unload();
+		easy.unload();
+		normal.unload();
+		hard.unload();
+		pointP1.unload();
+		pointP2.unload();
+		winsP1.unload();
+		winsP2.unload();
+		pressSpace.unload();
+		leftScore.unload();
+		rightScore.unload();
+		CloseWindow();
+	};
+
 	bool roundOver{ false },		// Point has been scored
 		gameOver{ false },			// Someone has 3 points
 		selectionMade{ false },		// 1- or 2-player has been selected
@@ -98,91 +206,135 @@ int main()
 
 	while(!WindowShouldClose())						
 	{	
+		// Nothing moves in the menus, so block in EndDrawing until there's input instead of redrawing the same frame.
+		// Waiting leaves a long frame time behind, so the first frame of gameplay after a menu skips its movement.
+		bool waitedInMenu = !selectionMade;
+		if (waitedInMenu)
+			EnableEventWaiting();
+
 		// Menu for selecting difficulty
 		while (!selectionMade)
 		{
 			// Make sure player can still exit from here.
 			if (WindowShouldClose())
 			{
-				CloseWindow();
+				closeWindow();
 				return 0;
 			}
+			ALLOC_SITE("Pong menu");
+
+			// Input is handled before drawing, so the frame an input wakes up shows what that input changed.
+			// Allow for toggling selection.
+			if (IsKeyPressed('W') || IsKeyPressed('S') || IsKeyPressed(KEY_DOWN) || IsKeyPressed(KEY_UP))
+				singlePlayer = !singlePlayer;
+
+			// Make selection. Stop waiting on input if going straight into a 2-player game.
+			// Either way, go right to the next screen instead of drawing this menu one more time.
+			if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE))
+			{
+				selectionMade = true;
+				if (!singlePlayer)
+					DisableEventWaiting();
+				continue;
+			}
 
 			BeginDrawing();
 			ClearBackground(BLACK);
 
 			// Draw menu text.
-			DrawText("PONG", (GetScreenWidth() - MeasureText("PONG", 100)) / 2, 10, 100, WHITE);
-			DrawText("1-Player Game", (GetScreenWidth() - MeasureText("1-Player Game", 50)) / 2, GetScreenHeight() / 2 - 60, 50, BLUE);
-			DrawText("2-Player Game", (GetScreenWidth() - MeasureText("1-Player Game", 50))  / 2, GetScreenHeight() / 2 + 10, 50, RED);
+			title.drawCentered(10);
+			onePlayer.draw(playerMenuX, GetScreenHeight() / 2 - 60);
+			twoPlayer.draw(playerMenuX, GetScreenHeight() / 2 + 10);
 			
 			// Draw selection cursor (pong ball) at correct position.
 			if(singlePlayer)
-				DrawCircle((GetScreenWidth() - MeasureText("1-Player Game", 50)) / 2 - 20, GetScreenHeight() / 2 - 35, 5, WHITE);
+				DrawCircle(playerMenuX - 20, GetScreenHeight() / 2 - 35, 5, WHITE);
 			else 
-				DrawCircle((GetScreenWidth() - MeasureText("1-Player Game", 50)) / 2 - 20, GetScreenHeight() / 2 + 35, 5, WHITE);
-
-			// Allow for toggling selection.
-			if (IsKeyPressed('W') || IsKeyPressed('S') || IsKeyPressed(KEY_DOWN) || IsKeyPressed(KEY_UP))
-				singlePlayer = !singlePlayer;
-
-			// Make selection.
-			if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE))
-				selectionMade = true;
+				DrawCircle(playerMenuX - 20, GetScreenHeight() / 2 + 35, 5, WHITE);
 			EndDrawing();
+
+			if (!allocFrameEnd())
+			{
+				closeWindow();
+				return 1;
+			}
 		}
 		
 		// Menu for selecting difficulty if 1-player was chosen.
+		// The key that picked 1-player hasn't been polled again yet when this menu opens, so it would still count as pressed here.
+		// Input is ignored until the menu has been drawn once to keep it from picking a difficulty too.
+		bool difficultyMenuShown{ false };
 		while (singlePlayer && !selectionMadeAI)
 		{
 			// Make sure player can still exit from here.
 			if (WindowShouldClose())
 			{
-				CloseWindow();
+				closeWindow();
 				return 0;
 			}
+			ALLOC_SITE("Pong difficulty menu");
+
+			// Input is handled before drawing, same as the menu above.
+			if (difficultyMenuShown)
+			{
+				// Allow for toggling selection and cycling menu.
+				if (IsKeyPressed('W') || IsKeyPressed(KEY_UP))
+				{
+					difficulty += 20;
+					if (difficulty > 40)
+						difficulty = 0;
+				}
+				if (IsKeyPressed('S') || IsKeyPressed(KEY_DOWN))
+				{
+					difficulty -= 20;
+					if (difficulty < 0)
+						difficulty = 40;
+				}
+
+				// Make selection and go right into the game.
+				if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE))
+				{
+					selectionMadeAI = true;
+					DisableEventWaiting();
+					continue;
+				}
+			}
+
 			BeginDrawing();
 			ClearBackground(BLACK);
 
 			// Draw menu text.
-			DrawText("Easy", (GetScreenWidth() - MeasureText("Easy", 50)) / 2, GetScreenHeight() / 2 - 100, 50, GREEN);
-			DrawText("Normal", (GetScreenWidth() - MeasureText("Easy", 50)) / 2, GetScreenHeight() / 2 - 25, 50, YELLOW);
-			DrawText("Hard", (GetScreenWidth() - MeasureText("Easy", 50)) / 2, GetScreenHeight() / 2 + 50, 50, RED);
+			easy.draw(difficultyMenuX, GetScreenHeight() / 2 - 100);
+			normal.draw(difficultyMenuX, GetScreenHeight() / 2 - 25);
+			hard.draw(difficultyMenuX, GetScreenHeight() / 2 + 50);
 
 			// Draw selection cursor (pong ball) at correct position.
 			if (difficulty == 40)
-				DrawCircle((GetScreenWidth() - MeasureText("Easy", 50)) / 2 - 20, GetScreenHeight() / 2 - 75, 5, WHITE);
+				DrawCircle(difficultyMenuX - 20, GetScreenHeight() / 2 - 75, 5, WHITE);
 			else if(difficulty == 20)
-				DrawCircle((GetScreenWidth() - MeasureText("Easy", 50)) / 2 - 20, GetScreenHeight() / 2 , 5, WHITE);
+				DrawCircle(difficultyMenuX - 20, GetScreenHeight() / 2 , 5, WHITE);
 			else if(difficulty == 0)
-				DrawCircle((GetScreenWidth() - MeasureText("Easy", 50)) / 2 - 20, GetScreenHeight() / 2 + 75, 5, WHITE);
+				DrawCircle(difficultyMenuX - 20, GetScreenHeight() / 2 + 75, 5, WHITE);
+			EndDrawing();
+			difficultyMenuShown = true;
 
-			// Allow for toggling selection and cycling menu.
-			if (IsKeyPressed('W') || IsKeyPressed(KEY_UP))
-			{
-				difficulty += 20;
-				if (difficulty > 40)
-					difficulty = 0;
-			}
-			if (IsKeyPressed('S') || IsKeyPressed(KEY_DOWN))
+			if (!allocFrameEnd())
 			{
-				difficulty -= 20;
-				if (difficulty < 0)
-					difficulty = 40;
+				closeWindow();
+				return 1;
 			}
+		}
 
-			// Make selection.
-			if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE))
-				selectionMadeAI = true;
 
-			EndDrawing();
-		}
 
+		ALLOC_SITE("Pong update");
 
+		// Frame time used for all movement this frame.
+		float frameTime = waitedInMenu ? 0.0f : GetFrameTime();
 
 		// Update ball position using current speed
-		ball.x += ball.speedX * GetFrameTime();
-		ball.y += ball.speedY * GetFrameTime();
+		ball.x += ball.speedX * frameTime;
+		ball.y += ball.speedY * frameTime;
 
 		// If ball bounces off top or bottom, reverse y-speed
 		if (ball.y < 0)
@@ -198,9 +350,9 @@ int main()
 
 		// Player 1 control
 		if(IsKeyDown('W') && leftPaddle.y > 0)
-			leftPaddle.y -= leftPaddle.speed * GetFrameTime();
+			leftPaddle.y -= leftPaddle.speed * frameTime;
 		if(IsKeyDown('S') && leftPaddle.y < GetScreenHeight()-leftPaddle.height)
-			leftPaddle.y += leftPaddle.speed * GetFrameTime();
+			leftPaddle.y += leftPaddle.speed * frameTime;
 
 
 
@@ -217,9 +369,9 @@ int main()
 				// Could have let the AI determine where the ball would end up by the time it got to the right side, but this would lead to a 
 				//	perfectly-centered hit every time leading to 0 y-speed. Boring.
 				if (ball.y > rightPaddle.y + rightPaddle.height / 2 && rightPaddle.y < GetScreenHeight() - rightPaddle.height)
-					rightPaddle.y += rightPaddle.speed * GetFrameTime();
+					rightPaddle.y += rightPaddle.speed * frameTime;
 				if (ball.y < rightPaddle.y + rightPaddle.height / 2 && rightPaddle.y > 0)
-					rightPaddle.y -= rightPaddle.speed * GetFrameTime();
+					rightPaddle.y -= rightPaddle.speed * frameTime;
 			}
 		
 		}
@@ -229,9 +381,9 @@ int main()
 		{
 			// Allow paddle to move up and down according to key press and restrict paddle to screen dimensions.
 			if (IsKeyDown(KEY_UP) && rightPaddle.y > 0)
-				rightPaddle.y -= rightPaddle.speed * GetFrameTime();
+				rightPaddle.y -= rightPaddle.speed * frameTime;
 			if (IsKeyDown(KEY_DOWN) && rightPaddle.y < GetScreenHeight() - rightPaddle.height)
-				rightPaddle.y += rightPaddle.speed * GetFrameTime();
+				rightPaddle.y += rightPaddle.speed * frameTime;
 		}
 
 
@@ -283,13 +435,6 @@ int main()
 					gameOver = true;
 				roundOver = true;
 			}
-			
-
-			// Display point message for end round or end game.
-			if(!gameOver)
-				DrawText("Point Player 2", (GetScreenWidth() - MeasureText("Point Player 2", 50))/2, 20, 50, RED);
-			else
-				DrawText("Player 2 Wins!", (GetScreenWidth() - MeasureText("Player 2 Wins!", 60)) / 2, GetScreenHeight()/2 - 30, 60, RED);
 		}
 
 		// If ball leaves right side of screen
@@ -304,23 +449,39 @@ int main()
 					gameOver = true;
 				roundOver = true;
 			}
-			
-
-			// Display point message for end round or end game.
-			if(!gameOver)
-				DrawText("Point Player 1", (GetScreenWidth() - MeasureText("Point Player 1", 50))/2, 20, 50, BLUE);
-			else
-				DrawText("Player 1 Wins!", (GetScreenWidth() - MeasureText("Player 1 Wins!", 60)) / 2, GetScreenHeight() / 2 - 30, 60, BLUE);
 		}
 
+		ALLOC_SITE("Pong draw");
+
+		// Re-render score text if either score changed.
+		leftScore.update(leftPaddle.score);
+		rightScore.update(rightPaddle.score);
+
 
 		BeginDrawing();									
 			ClearBackground(BLACK);	
 
+			// Display point message for end round or end game.
+			// (Drawn here rather than where the point is scored, since cached text has to be drawn after ClearBackground.)
+			if (ball.x <= 0)
+			{
+				if (!gameOver)
+					pointP2.drawCentered(20);
+				else
+					winsP2.drawCentered(GetScreenHeight() / 2 - 30);
+			}
+			if (ball.x >= GetScreenWidth())
+			{
+				if (!gameOver)
+					pointP1.drawCentered(20);
+				else
+					winsP1.drawCentered(GetScreenHeight() / 2 - 30);
+			}
+
 			// Wait for input to restart.
 			if (roundOver)
 			{
-				DrawText("(Press SPACE to Continue)", (GetScreenWidth() - MeasureText("(Press SPACE to Continue)", 30)) / 2, GetScreenHeight() - 40, 30, WHITE);
+				pressSpace.drawCentered(GetScreenHeight() - 40);
 				if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE))
 				{
 					// If game is over, reset scores and paddles to center.
@@ -344,17 +505,23 @@ int main()
 			DrawCircle((int)ball.x, (int)ball.y, ball.radius, WHITE);													// Ball
 
 			DrawRectangle(leftPaddle.x, leftPaddle.y, leftPaddle.width, leftPaddle.height, BLUE);						// Left paddle
-			DrawText(TextFormat("%d", leftPaddle.score), MeasureText("0", 60) - 5, GetScreenHeight()-60, 40, BLUE);		// Left score
+			leftScore.text.draw(leftScoreX, GetScreenHeight() - 60);													// Left score
 
 			DrawRectangle(rightPaddle.x, rightPaddle.y, rightPaddle.width, rightPaddle.height, RED);					// Right paddle
-			DrawText(TextFormat("%d", rightPaddle.score), GetScreenWidth() - MeasureText("0", 60) - MeasureText("0", 40) + 5, GetScreenHeight() - 60, 40, RED);
-																														// Right score
+			rightScore.text.draw(rightScoreX, GetScreenHeight() - 60);												// Right score
 
 
 		DrawFPS(0, 0);							
 		EndDrawing();									
+
+		// Allocation tracking. Only does anything in a TRACK_ALLOCATIONS build, where this fails the run if a frame goes over budget.
+		if (!allocFrameEnd())
+		{
+			closeWindow();
+			return 1;
+		}
 	}
 
-	CloseWindow();										
+	closeWindow();										
 	return 0;
 }
\ No newline at end of file
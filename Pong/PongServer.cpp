@@ -0,0 +1,831 @@
+////////////////////
+// Chase Meadows
+//
+// Headless Pong server for AI-vs-client play.
+//
+// Same rules as Pong.cpp, just without a window, so one process can host thousands of matches at once.
+//	Every match lives in one compact pooled table, and all active matches are stepped together at a fixed 60 ticks/sec
+//	across a pool of worker threads.
+//	Clients talk to the server over UDP. A client controls the left paddle of its match and the server AI plays the right.
+//	A match closes when its client leaves, or after 10 seconds without input from a client that's gone away,
+//	and each client address can only hold so many matches open at once.
+//	Socket reads and writes are non-blocking and batched twice over: each datagram carries the records for many matches
+//	with the same owner, and datagrams go through recvmmsg/sendmmsg on Linux (a plain loop elsewhere).
+//
+// Usage:
+//	PongServer [port]				Run the server (default port 7777).
+//	PongServer --bench [matches]	Run the server together with a simulated-client load generator over loopback.
+//									Match count doubles each step up to [matches] (default 4000), reporting tick latency
+//									percentiles and estimated matches per core at each step.
+//
+// Messages are sent in native byte order, so clients are assumed to be on the same kind of machine.
+//
+#ifdef _WIN32
+#define NOMINMAX				// Keeps <windows.h> (pulled in by winsock2.h) from defining min/max macros over std::min/std::max.
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+// Gameplay constants, matching Pong.cpp.
+const float SCREEN_WIDTH = 800;
+const float SCREEN_HEIGHT = 600;
+const float PADDLE_SPEED = 300;
+const float BALL_SPEED = 180;
+const float MAX_VERTICAL = 400;
+const float PADDLE_WIDTH = 10;
+const float PADDLE_HEIGHT = 100;
+const float BALL_RADIUS = 5;
+const float LEFT_PADDLE_X = 50;
+const float RIGHT_PADDLE_X = SCREEN_WIDTH - 50 - PADDLE_WIDTH;
+
+// Server constants.
+const int TICK_RATE = 60;								// Fixed simulation steps per second.
+const float TICK_SECONDS = 1.0f / TICK_RATE;
+const int DEFAULT_PORT = 7777;
+const int MAX_MATCHES = 65536;							// Size of the match pool.
+const int MAX_MATCHES_PER_OWNER = 256;					// Most matches one client address can have open at once.
+const int IDLE_TIMEOUT_TICKS = 10 * TICK_RATE;			// Matches that get no input for this long are closed.
+const int BATCH_SIZE = 64;								// Datagrams per batched socket call.
+const int MAX_DATAGRAM = 1200;							// Largest datagram sent, kept under a typical MTU.
+const int AI_DIFFICULTY = 20;							// Same meaning as in Pong.cpp (Normal).
+const int BENCH_TICKS = 3 * TICK_RATE;					// Ticks measured at each load generator step.
+
+
+//////////////////////////////
+// Sockets
+#ifdef _WIN32
+typedef SOCKET Socket;
+const Socket BAD_SOCKET = INVALID_SOCKET;
+void closeSocket(Socket s) { closesocket(s); }
+#else
+typedef int Socket;
+const Socket BAD_SOCKET = -1;
+void closeSocket(Socket s) { close(s); }
+#endif
+
+// Opens a non-blocking UDP socket bound to the given port (0 picks any free port).
+Socket openSocket(uint32_t address, int port)
+{
+	Socket s = socket(AF_INET, SOCK_DGRAM, 0);
+	if (s == BAD_SOCKET)
+		return BAD_SOCKET;
+
+	// Thousands of matches means thousands of datagrams a tick, so ask for big buffers.
+	int bufferSize = 8 * 1024 * 1024;
+	setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char*)&bufferSize, sizeof(bufferSize));
+	setsockopt(s, SOL_SOCKET, SO_SNDBUF, (const char*)&bufferSize, sizeof(bufferSize));
+
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(address);
+	addr.sin_port = htons((uint16_t)port);
+	if (bind(s, (sockaddr*)&addr, sizeof(addr)) != 0)
+	{
+		closeSocket(s);
+		return BAD_SOCKET;
+	}
+
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	ioctlsocket(s, FIONBIO, &nonBlocking);
+#else
+	fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+	return s;
+}
+
+bool sameAddress(const sockaddr_in& a, const sockaddr_in& b)
+{
+	return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+
+//////////////////////////////
+// Messages
+// A datagram is just a run of same-sized records back to back: input records from the client, state records from the server.
+enum MessageType : uint8_t
+{
+	MSG_JOIN = 1,		// Client -> server: start a new match.
+	MSG_INPUT,			// Client -> server: paddle input for a match.
+	MSG_LEAVE,			// Client -> server: end a match.
+	MSG_STATE			// Server -> client: match state after a tick.
+};
+
+#pragma pack(push, 1)
+struct InputMessage
+{
+	uint8_t type;
+	int8_t input;		// -1 up, 0 stay, 1 down
+	uint16_t unused;
+	uint32_t match;		// Ignored for MSG_JOIN.
+};
+
+struct StateMessage
+{
+	uint8_t type;
+	uint8_t leftScore, rightScore;
+	uint8_t unused;
+	uint32_t match;
+	uint32_t tick;
+	float ballX, ballY;
+	float leftY, rightY;
+};
+#pragma pack(pop)
+
+const int INPUTS_PER_DATAGRAM = MAX_DATAGRAM / sizeof(InputMessage);
+
+// One datagram and who it's from / going to.
+struct Packet
+{
+	sockaddr_in addr;
+	int size;
+	char data[MAX_DATAGRAM];
+};
+
+// Reads up to max waiting datagrams without blocking. Returns how many were read.
+int receiveBatch(Socket s, Packet* packets, int max)
+{
+#ifdef __linux__
+	mmsghdr headers[BATCH_SIZE];
+	iovec buffers[BATCH_SIZE];
+	max = std::min(max, BATCH_SIZE);
+	for (int i{}; i < max; i++)
+	{
+		buffers[i] = { packets[i].data, sizeof(packets[i].data) };
+		headers[i] = {};
+		headers[i].msg_hdr.msg_name = &packets[i].addr;
+		headers[i].msg_hdr.msg_namelen = sizeof(packets[i].addr);
+		headers[i].msg_hdr.msg_iov = &buffers[i];
+		headers[i].msg_hdr.msg_iovlen = 1;
+	}
+	int count = recvmmsg(s, headers, max, MSG_DONTWAIT, nullptr);
+	if (count < 0)
+		return 0;
+	for (int i{}; i < count; i++)
+		packets[i].size = (int)headers[i].msg_len;
+	return count;
+#else
+	int count{};
+	for (; count < max; count++)
+	{
+		socklen_t length = sizeof(packets[count].addr);
+		int size = recvfrom(s, packets[count].data, sizeof(packets[count].data), 0, (sockaddr*)&packets[count].addr, &length);
+		if (size < 0)
+			break;
+		packets[count].size = size;
+	}
+	return count;
+#endif
+}
+
+// Sends count datagrams without blocking. Anything the socket can't take right now is dropped.
+// (Fine for this, since every tick sends a fresh state anyway.)
+void sendBatch(Socket s, Packet* packets, int count)
+{
+#ifdef __linux__
+	mmsghdr headers[BATCH_SIZE];
+	iovec buffers[BATCH_SIZE];
+	while (count > 0)
+	{
+		int batch = std::min(count, BATCH_SIZE);
+		for (int i{}; i < batch; i++)
+		{
+			buffers[i] = { packets[i].data, (size_t)packets[i].size };
+			headers[i] = {};
+			headers[i].msg_hdr.msg_name = &packets[i].addr;
+			headers[i].msg_hdr.msg_namelen = sizeof(packets[i].addr);
+			headers[i].msg_hdr.msg_iov = &buffers[i];
+			headers[i].msg_hdr.msg_iovlen = 1;
+		}
+		int sent = sendmmsg(s, headers, batch, MSG_DONTWAIT);
+		if (sent <= 0)
+			return;
+		packets += sent;
+		count -= sent;
+	}
+#else
+	for (int i{}; i < count; i++)
+		sendto(s, packets[i].data, packets[i].size, 0, (const sockaddr*)&packets[i].addr, sizeof(packets[i].addr));
+#endif
+}
+
+
+//////////////////////////////
+// Match definition
+// All of one game's state, kept small so thousands of them stay packed together in the pool.
+struct Match
+{
+	float ballX, ballY;
+	float ballSpeedX, ballSpeedY;
+	float leftY, rightY;
+	uint32_t rng;				// Each match has its own generator, since rand() isn't safe to share across worker threads.
+	int8_t leftInput;			// Latest input from the client.
+	uint8_t leftScore, rightScore;
+
+	// Starts a fresh game.
+	void init(uint32_t seed)
+	{
+		rng = seed ? seed : 1;
+		leftInput = 0;
+		leftScore = 0;
+		rightScore = 0;
+		leftY = SCREEN_HEIGHT / 2 - PADDLE_HEIGHT / 2;
+		rightY = leftY;
+		resetBall();
+	}
+
+	// Same as Ball::init in Pong.cpp.
+	void resetBall()
+	{
+		ballX = SCREEN_WIDTH / 2.0f;
+		ballY = SCREEN_HEIGHT / 2.0f;
+		ballSpeedX = random(20) + BALL_SPEED;
+		if (random(2) == 1)
+			ballSpeedX *= -1;
+		ballSpeedY = random(100) + 150.0f;
+		if (random(2) == 1)
+			ballSpeedY *= -1;
+	}
+
+	// xorshift32, returns 0 to n-1.
+	int random(int n)
+	{
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+		return (int)(rng % (uint32_t)n);
+	}
+
+	// Bounces the ball off a paddle. Same as the paddle collision in Pong.cpp.
+	void hitPaddle(float paddleY)
+	{
+		ballSpeedY = ballSpeedY > 0 ? 1.0f : -1.0f;
+		ballSpeedY *= std::abs(ballY - (paddleY + PADDLE_HEIGHT / 2.0f)) / (PADDLE_HEIGHT / 2.0f) * MAX_VERTICAL;
+		ballSpeedX *= -1.1f;
+	}
+
+	bool ballHits(float paddleX, float paddleY) const
+	{
+		// Closest point on the paddle to the ball, same test as raylib's CheckCollisionCircleRec.
+		float closestX = std::clamp(ballX, paddleX, paddleX + PADDLE_WIDTH);
+		float closestY = std::clamp(ballY, paddleY, paddleY + PADDLE_HEIGHT);
+		float dx = ballX - closestX, dy = ballY - closestY;
+		return dx * dx + dy * dy <= BALL_RADIUS * BALL_RADIUS;
+	}
+
+	// Advances the match by one fixed step.
+	// Scoring works like Pong.cpp, except there's no one to press SPACE, so rounds restart right away and a new game starts after 3 points.
+	void tick()
+	{
+		ballX += ballSpeedX * TICK_SECONDS;
+		ballY += ballSpeedY * TICK_SECONDS;
+
+		// Bounce off top and bottom.
+		if (ballY < 0)
+		{
+			ballY = 0;
+			ballSpeedY *= -1;
+		}
+		if (ballY > SCREEN_HEIGHT)
+		{
+			ballY = SCREEN_HEIGHT;
+			ballSpeedY *= -1;
+		}
+
+		// Client control of left paddle.
+		if (leftInput < 0 && leftY > 0)
+			leftY -= PADDLE_SPEED * TICK_SECONDS;
+		if (leftInput > 0 && leftY < SCREEN_HEIGHT - PADDLE_HEIGHT)
+			leftY += PADDLE_SPEED * TICK_SECONDS;
+
+		// AI control of right paddle, same as Pong.cpp.
+		if (random(100) > AI_DIFFICULTY)
+		{
+			if (ballY > rightY + PADDLE_HEIGHT / 2 && rightY < SCREEN_HEIGHT - PADDLE_HEIGHT)
+				rightY += PADDLE_SPEED * TICK_SECONDS;
+			if (ballY < rightY + PADDLE_HEIGHT / 2 && rightY > 0)
+				rightY -= PADDLE_SPEED * TICK_SECONDS;
+		}
+
+		if (ballHits(RIGHT_PADDLE_X, rightY))
+		{
+			hitPaddle(rightY);
+			ballX = RIGHT_PADDLE_X - BALL_RADIUS / 2.0f;
+		}
+		if (ballHits(LEFT_PADDLE_X, leftY))
+		{
+			hitPaddle(leftY);
+			ballX = LEFT_PADDLE_X + BALL_RADIUS + PADDLE_WIDTH;
+		}
+
+		// Point scored.
+		if (ballX <= 0 || ballX >= SCREEN_WIDTH)
+		{
+			if (ballX <= 0)
+				rightScore++;
+			else
+				leftScore++;
+			if (leftScore == 3 || rightScore == 3)
+				leftScore = rightScore = 0;
+			resetBall();
+		}
+	}
+};
+
+//////////////////////////////
+// Match pool
+// Fixed-size table of matches, allocated once. Closed slots go on a free list and get reused by the next join.
+// Who owns each match is kept in its own array, since it's only needed when sending and not while ticking.
+// The slots in use are also kept in a dense list, so ticking and sending only ever look at live matches
+// instead of scanning the whole table.
+struct MatchPool
+{
+	std::vector<Match> matches;
+	std::vector<uint8_t> active;
+	std::vector<sockaddr_in> owners;
+	std::vector<uint32_t> freeSlots;
+	std::vector<uint32_t> live;			// Slots in use, in no particular order.
+	std::vector<uint32_t> livePos;		// Where each slot in use sits in live.
+	std::vector<uint32_t> lastHeard;	// Tick each match last got input (or was opened).
+	std::unordered_map<uint64_t, int> ownerCounts;	// Matches open per client address.
+	int ownerLimit{ MAX_MATCHES_PER_OWNER };
+	int activeCount{};
+	uint32_t seed{ 12345 };
+
+	MatchPool(int capacity) : matches(capacity), active(capacity), owners(capacity), livePos(capacity), lastHeard(capacity)
+	{
+		// Hand out low slots first so active matches stay packed toward the front of the table.
+		freeSlots.reserve(capacity);
+		live.reserve(capacity);
+		for (int i = capacity - 1; i >= 0; i--)
+			freeSlots.push_back((uint32_t)i);
+	}
+
+	static uint64_t ownerKey(const sockaddr_in& owner)
+	{
+		return (uint64_t)owner.sin_addr.s_addr << 16 | owner.sin_port;
+	}
+
+	// Returns the new match's slot, or -1 if the pool is full or the owner already has as many matches as it's allowed.
+	int open(const sockaddr_in& owner, uint32_t now)
+	{
+		if (freeSlots.empty())
+			return -1;
+		int& owned = ownerCounts[ownerKey(owner)];
+		if (owned >= ownerLimit)
+			return -1;
+		owned++;
+		uint32_t slot = freeSlots.back();
+		freeSlots.pop_back();
+		matches[slot].init(seed++ * 2654435761u);
+		active[slot] = 1;
+		owners[slot] = owner;
+		lastHeard[slot] = now;
+		livePos[slot] = (uint32_t)live.size();
+		live.push_back(slot);
+		activeCount++;
+		return (int)slot;
+	}
+
+	void close(uint32_t slot)
+	{
+		// Move the last live slot into the gap so the list stays dense.
+		uint32_t last = live.back();
+		live[livePos[slot]] = last;
+		livePos[last] = livePos[slot];
+		live.pop_back();
+
+		auto owned = ownerCounts.find(ownerKey(owners[slot]));
+		if (--owned->second == 0)
+			ownerCounts.erase(owned);
+
+		active[slot] = 0;
+		freeSlots.push_back(slot);
+		activeCount--;
+	}
+
+	// Closes every match that hasn't heard from its client in IDLE_TIMEOUT_TICKS.
+	// There's no connection to notice dropping over UDP, so this is how a client that crashed or went away gives its slots back.
+	void closeIdle(uint32_t now)
+	{
+		// Backwards, since closing moves the last live match into the closed one's place.
+		for (size_t i = live.size(); i-- > 0;)
+			if (now - lastHeard[live[i]] > (uint32_t)IDLE_TIMEOUT_TICKS)
+				close(live[i]);
+	}
+
+	// Only lets a client touch matches it owns.
+	bool owns(uint32_t slot, const sockaddr_in& client) const
+	{
+		return slot < matches.size() && active[slot] && sameAddress(owners[slot], client);
+	}
+};
+
+//////////////////////////////
+// Worker pool
+// Persistent threads that each run a share of a job, so ticking doesn't spin up threads every frame.
+struct WorkerPool
+{
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable start, done;
+	std::function<void(int, int)> job;		// Called with (worker index, worker count).
+	uint64_t generation{};
+	int remaining{};
+	bool quit{};
+
+	WorkerPool(int count)
+	{
+		for (int i{}; i < count; i++)
+			threads.emplace_back([this, i, count] { work(i, count); });
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		start.notify_all();
+		for (auto& t : threads)
+			t.join();
+	}
+
+	// Runs job on every worker and waits for all of them to finish.
+	void run(std::function<void(int, int)> newJob)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		job = std::move(newJob);
+		remaining = (int)threads.size();
+		generation++;
+		start.notify_all();
+		done.wait(lock, [this] { return remaining == 0; });
+	}
+
+	void work(int index, int count)
+	{
+		uint64_t seen{};
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			start.wait(lock, [&] { return quit || generation != seen; });
+			if (quit)
+				return;
+			seen = generation;
+			lock.unlock();
+
+			job(index, count);
+
+			lock.lock();
+			if (--remaining == 0)
+				done.notify_one();
+		}
+	}
+};
+
+// Returns the p-th percentile (0 to 1) of sorted values.
+double percentile(const std::vector<double>& sorted, double p)
+{
+	return sorted[std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5))];
+}
+
+//////////////////////////////
+// Server definition
+struct Server
+{
+	Socket socket;
+	MatchPool pool;
+	WorkerPool workers;
+	uint32_t tickCount{};
+	std::vector<Packet> packets;
+	std::vector<double> tickTimes, simTimes;	// Seconds spent on each tick, and on just the simulation part of it.
+	std::vector<double> busyTimes;				// Seconds each worker spent ticking matches this tick.
+	double busyTotal{};							// Worker seconds spent ticking matches since the last report...
+	long long matchTicks{};						// ...and how many match steps that bought.
+
+	Server(Socket socket, int workerCount) : socket{ socket }, pool(MAX_MATCHES), workers(workerCount), packets(BATCH_SIZE), busyTimes(workerCount) {}
+
+	// Handles every datagram waiting on the socket.
+	void receive()
+	{
+		int count;
+		while ((count = receiveBatch(socket, packets.data(), BATCH_SIZE)) > 0)
+			for (int i{}; i < count; i++)
+			{
+				const Packet& p = packets[i];
+				for (int offset{}; offset + (int)sizeof(InputMessage) <= p.size; offset += sizeof(InputMessage))
+				{
+					InputMessage msg;
+					std::memcpy(&msg, p.data + offset, sizeof(msg));
+
+					if (msg.type == MSG_JOIN)
+						pool.open(p.addr, tickCount);
+					else if (msg.type == MSG_INPUT && pool.owns(msg.match, p.addr))
+					{
+						pool.matches[msg.match].leftInput = std::clamp<int8_t>(msg.input, -1, 1);
+						pool.lastHeard[msg.match] = tickCount;
+					}
+					else if (msg.type == MSG_LEAVE && pool.owns(msg.match, p.addr))
+						pool.close(msg.match);
+				}
+			}
+	}
+
+	// Steps every active match, with each worker taking an even slice of the live list.
+	// Each worker times its own slice, so matches per core can be worked out from time actually spent ticking.
+	void simulate()
+	{
+		workers.run([this](int index, int count) {
+			auto begin = std::chrono::steady_clock::now();
+			size_t size = pool.live.size();
+			size_t first = size * index / count, end = size * (index + 1) / count;
+			for (size_t i = first; i < end; i++)
+				pool.matches[pool.live[i]].tick();
+			busyTimes[index] = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		});
+		for (double t : busyTimes)
+			busyTotal += t;
+		matchTicks += pool.live.size();
+	}
+
+	// Sends each match's state to its owner.
+	// Back-to-back matches with the same owner share a datagram. Joins add to the end of the live list, so a client's matches
+	// mostly stay next to each other there (closing a match only moves one other match into its place).
+	void send()
+	{
+		int count{};
+		for (uint32_t i : pool.live)
+		{
+			// Start a new datagram if this match goes somewhere else or the current one is full.
+			if (count == 0 || !sameAddress(packets[count - 1].addr, pool.owners[i]) || packets[count - 1].size + (int)sizeof(StateMessage) > MAX_DATAGRAM)
+			{
+				if (count == BATCH_SIZE)
+				{
+					sendBatch(socket, packets.data(), count);
+					count = 0;
+				}
+				packets[count].addr = pool.owners[i];
+				packets[count].size = 0;
+				count++;
+			}
+
+			const Match& m = pool.matches[i];
+			StateMessage msg{ MSG_STATE, m.leftScore, m.rightScore, 0, i, tickCount, m.ballX, m.ballY, m.leftY, m.rightY };
+			Packet& p = packets[count - 1];
+			std::memcpy(p.data + p.size, &msg, sizeof(msg));
+			p.size += sizeof(msg);
+		}
+		sendBatch(socket, packets.data(), count);
+	}
+
+	// One full server tick: read input, step all matches, send out new state.
+	void tick()
+	{
+		auto begin = std::chrono::steady_clock::now();
+		receive();
+		if (tickCount % TICK_RATE == 0)
+			pool.closeIdle(tickCount);
+		auto simBegin = std::chrono::steady_clock::now();
+		simulate();
+		auto simEnd = std::chrono::steady_clock::now();
+		send();
+		tickCount++;
+		auto end = std::chrono::steady_clock::now();
+
+		tickTimes.push_back(std::chrono::duration<double>(end - begin).count());
+		simTimes.push_back(std::chrono::duration<double>(simEnd - simBegin).count());
+	}
+
+	// Prints tick latency percentiles and estimated matches per core since the last report, then starts a new period.
+	void report()
+	{
+		if (tickTimes.empty())
+			return;
+		std::vector<double> sorted = tickTimes;
+		std::sort(sorted.begin(), sorted.end());
+		double simMean{};
+		for (double t : simTimes)
+			simMean += t;
+		simMean /= simTimes.size();
+
+		// How many matches one core could keep up with at TICK_RATE, going by how long the workers were actually busy per match step.
+		double perCore = busyTotal > 0 ? matchTicks * TICK_SECONDS / busyTotal : 0;
+
+		std::printf("%8d %10.3f %10.3f %10.3f %10.3f %10.3f %14.0f\n", pool.activeCount,
+			percentile(sorted, 0.50) * 1000, percentile(sorted, 0.95) * 1000, percentile(sorted, 0.99) * 1000,
+			sorted.back() * 1000, simMean * 1000, perCore);
+		std::fflush(stdout);
+
+		clearStats();
+	}
+
+	void clearStats()
+	{
+		tickTimes.clear();
+		simTimes.clear();
+		busyTotal = 0;
+		matchTicks = 0;
+	}
+
+	static void printReportHeader()
+	{
+		std::printf("%8s %10s %10s %10s %10s %10s %14s\n", "matches", "p50 ms", "p95 ms", "p99 ms", "max ms", "sim ms", "matches/core");
+	}
+
+	// Runs at a fixed TICK_RATE for the given number of ticks.
+	// If ticks is negative, runs forever and reports every 10 seconds.
+	void run(int ticks)
+	{
+		const auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(TICK_SECONDS));
+		auto next = std::chrono::steady_clock::now();
+		for (int i{}; ticks < 0 || i < ticks; i++)
+		{
+			tick();
+			if (ticks < 0 && tickTimes.size() >= 10 * TICK_RATE)
+				report();
+			next += step;
+			// If a tick ran long enough to fall more than a step behind, don't try to catch up in a burst.
+			auto now = std::chrono::steady_clock::now();
+			if (now - next > step)
+				next = now;
+			std::this_thread::sleep_until(next);
+		}
+	}
+};
+
+//////////////////////////////
+// Load generator
+// Simulated clients for testing. Joins matches, then answers every state it gets with input that
+// chases the ball, like the AI in Pong.cpp does.
+struct LoadGenerator
+{
+	Socket socket;
+	sockaddr_in server{};
+	std::atomic<bool> stop{ false };
+	std::thread thread;
+
+	LoadGenerator(Socket socket, int port) : socket{ socket }
+	{
+		server.sin_family = AF_INET;
+		server.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		server.sin_port = htons((uint16_t)port);
+		thread = std::thread([this] { run(); });
+	}
+
+	~LoadGenerator()
+	{
+		stop = true;
+		thread.join();
+	}
+
+	// Asks the server for count more matches. (Any joins dropped by a full socket buffer can just be asked for again.)
+	void join(int count)
+	{
+		Packet packet;
+		InputMessage msg{ MSG_JOIN, 0, 0, 0 };
+		packet.addr = server;
+		while (count > 0)
+		{
+			int batch = std::min(count, INPUTS_PER_DATAGRAM);
+			packet.size = 0;
+			for (int i{}; i < batch; i++)
+			{
+				std::memcpy(packet.data + packet.size, &msg, sizeof(msg));
+				packet.size += sizeof(msg);
+			}
+			sendBatch(socket, &packet, 1);
+			count -= batch;
+		}
+	}
+
+	void run()
+	{
+		std::vector<Packet> in(BATCH_SIZE), out(BATCH_SIZE);
+		while (!stop)
+		{
+			int count = receiveBatch(socket, in.data(), BATCH_SIZE);
+			if (count == 0)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+				continue;
+			}
+			// Each state datagram gets one input datagram back with a record for every match in it.
+			for (int i{}; i < count; i++)
+			{
+				out[i].addr = server;
+				out[i].size = 0;
+				for (int offset{}; offset + (int)sizeof(StateMessage) <= in[i].size; offset += sizeof(StateMessage))
+				{
+					StateMessage state;
+					std::memcpy(&state, in[i].data + offset, sizeof(state));
+					float center = state.leftY + PADDLE_HEIGHT / 2;
+					InputMessage msg{ MSG_INPUT, (int8_t)(state.ballY > center ? 1 : state.ballY < center ? -1 : 0), 0, state.match };
+					std::memcpy(out[i].data + out[i].size, &msg, sizeof(msg));
+					out[i].size += sizeof(msg);
+				}
+			}
+			sendBatch(socket, out.data(), count);
+		}
+	}
+};
+
+// Ramps up simulated matches and reports how the server's tick holds up at each step.
+int bench(int maxMatches, int workerCount)
+{
+	Socket serverSocket = openSocket(INADDR_LOOPBACK, 0);
+	Socket clientSocket = openSocket(INADDR_LOOPBACK, 0);
+	if (serverSocket == BAD_SOCKET || clientSocket == BAD_SOCKET)
+	{
+		std::printf("Couldn't open loopback sockets.\n");
+		return 1;
+	}
+	sockaddr_in addr{};
+	socklen_t length = sizeof(addr);
+	getsockname(serverSocket, (sockaddr*)&addr, &length);
+
+	Server server(serverSocket, workerCount);
+	server.pool.ownerLimit = maxMatches;	// All the simulated clients share one address.
+	LoadGenerator clients(clientSocket, ntohs(addr.sin_port));
+
+	std::printf("%d worker threads, %d ticks per step\n", workerCount, BENCH_TICKS);
+	Server::printReportHeader();
+	for (int matches = std::min(250, maxMatches); ; matches = std::min(matches * 2, maxMatches))
+	{
+		// Keep asking for joins until the server has them all.
+		while (server.pool.activeCount < matches)
+		{
+			clients.join(matches - server.pool.activeCount);
+			server.tick();
+		}
+
+		server.run(TICK_RATE / 2);	// Let things settle before measuring.
+		server.clearStats();
+		server.run(BENCH_TICKS);
+		server.report();
+
+		if (matches == maxMatches)
+			break;
+	}
+
+	closeSocket(clientSocket);
+	closeSocket(serverSocket);
+	return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+#ifdef _WIN32
+	WSADATA wsa;
+	WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+	// Leave one core free for the network thread.
+	int workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+	if (argc > 1 && std::strcmp(argv[1], "--bench") == 0)
+	{
+		int maxMatches = argc > 2 ? std::atoi(argv[2]) : 4000;
+		return bench(std::clamp(maxMatches, 1, MAX_MATCHES), workerCount);
+	}
+
+	int port = argc > 1 ? std::atoi(argv[1]) : DEFAULT_PORT;
+	Socket s = openSocket(INADDR_ANY, port);
+	if (s == BAD_SOCKET)
+	{
+		std::printf("Couldn't open port %d.\n", port);
+		return 1;
+	}
+	std::printf("Pong server on port %d with %d worker threads.\n", port, workerCount);
+	Server::printReportHeader();
+	std::fflush(stdout);
+
+	Server server(s, workerCount);
+	server.run(-1);
+
+	closeSocket(s);
+	return 0;
+}